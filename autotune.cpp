@@ -0,0 +1,79 @@
+#include <random>
+#include "src/PS.h"
+#include "src/CP.cpp"
+
+// Offline search of the RunPS_CP parameters. Every instance runs the default
+// and --trials random configurations, starting from the left-shifted
+// traditional schedule, for --scale times the production timeLimit() (at
+// least 5 s) or --seconds each. The best one is written together with the
+// instance features; the scheduler takes the one of the nearest instance and
+// always solves under timeLimit().
+int main(int argc, char **argv) {
+    uint32_t trials = 8;
+    double scale = 0.01, seconds = 0;  // seconds = 0: scale * timeLimit()
+    uint64_t seed = 1;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trials") == 0 && i+1 < argc) trials = std::stoul(argv[++i]);
+        else if (strcmp(argv[i], "--scale") == 0 && i+1 < argc) scale = std::stod(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i+1 < argc) seconds = std::stod(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) seed = std::stoull(argv[++i]);
+        else args.push_back(argv[i]);
+    }
+    if (args.size() < 2) {
+        std::cerr << "Usage: autotune [--trials N] [--scale F | --seconds S] [--seed N] CONFIG_FILE TESTCASE...\n";
+        return 1;
+    }
+
+    const uint16_t group_sizes[] = {0, 6, 12, 20, 30};
+    const std::string orders[] = {"weight", "ratio", "duration"};
+    const uint16_t workers[] = {8, 16, 32};
+    const int branchings[] = {-1, 0, 1, 2};  // default, AUTOMATIC, FIXED, PORTFOLIO
+    const int linearizations[] = {-1, 0, 1, 2};
+    std::mt19937_64 rng(seed);
+    auto pick = [&](const auto &options) {
+        return options[std::uniform_int_distribution<size_t>(0, std::size(options) - 1)(rng)];
+    };
+
+    std::ofstream conf(args[0]);
+    conf << "# l n ops dep_density weight_spread group_size order workers search_branching linearization_level\n";
+    for (size_t f = 1; f < args.size(); f++) {
+        auto [l, jobs] = ReadJobs(args[f]);
+        // The scheduler runs CP-SAT only with 2 or more slices
+        if (l < 2) continue;
+        uint32_t m = 0;
+        for (auto &j : jobs) m += j.ops.size();
+        const uint32_t TradSpan = TraditionalScheduling(jobs, l);
+        const long double base = LeftShift(jobs, l);
+        const double budget = seconds > 0 ? seconds : std::max(5.0, timeLimit(l, m, false) * scale);
+
+        auto evaluate = [&](const CPConfig &c) {
+            std::vector<Job> trial(jobs);
+            const operations_research::sat::CpSolverStatus status =
+                operations_research::sat::RunPS_CP(trial, l, base, TradSpan*1.5, true, "", m * l > 2000, c);
+            if (status != operations_research::sat::CpSolverStatus::OPTIMAL &&
+                status != operations_research::sat::CpSolverStatus::FEASIBLE) return base;
+            return std::min(base, LeftShift(trial, l));
+        };
+        CPConfig best;
+        best.max_time = budget;
+        long double best_score = evaluate(best);
+        for (uint32_t t = 0; t < trials; t++) {
+            CPConfig c;
+            c.group_size = pick(group_sizes);
+            c.order = pick(orders);
+            c.workers = pick(workers);
+            c.search_branching = pick(branchings);
+            c.linearization_level = pick(linearizations);
+            c.max_time = budget;
+            const long double score = evaluate(c);
+            if (score < best_score) {
+                best = c;
+                best_score = score;
+            }
+        }
+        WriteCPConfig(conf, Features(jobs, l), best);
+        conf.flush();
+        std::cout << args[f] << " " << std::fixed << std::setprecision(8) << base << " -> " << best_score << '\n';
+    }
+}
@@ -1,29 +1,81 @@
 #include "src/PS.h"
 #include "src/CP.cpp"
+#include "src/MIP.cpp"
+#include "src/Backend.cpp"
 
 int main(int argc, char **argv) {
-    long double score, score2;
+    long double score;
     uint32_t TradSpan, m = 0;
     operations_research::sat::CpSolverStatus PS_CP = operations_research::sat::CpSolverStatus::UNKNOWN;
     bool PS_CP_OK = false;
-    assert(argc >= 3);
-    auto [l, jobs] = ReadJobs(argv[1]);
+    GAParams ga;
+    std::vector<std::string> args;
+    std::string cache, mip{"SCIP"}, export_file, config_file{"autotune.conf"};
+    bool lazy = false, contract = false;
+    ChainMap chains;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) ga.seed = std::stoull(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) ga.threads = std::stoul(argv[++i]);
+        else if (strcmp(argv[i], "--model-cache") == 0 && i+1 < argc) cache = argv[++i];
+        else if (strcmp(argv[i], "--lazy") == 0) lazy = true;
+        else if (strcmp(argv[i], "--contract-chains") == 0) contract = true;
+        else if (strcmp(argv[i], "--config") == 0 && i+1 < argc) config_file = argv[++i];
+        else if (strcmp(argv[i], "--mip") == 0 && i+1 < argc) mip = argv[++i];
+        else if (strcmp(argv[i], "--export") == 0 && i+1 < argc) export_file = argv[++i];
+        else args.push_back(argv[i]);
+    }
+    if (args.size() < 2) {
+        std::cerr << "Usage: scheduler [options] TESTCASE OUTPUT\n";
+        return 1;
+    }
+    if (!cache.empty()) cache += "/" + args[0].substr(args[0].find_last_of('/')+1);
+    auto [l, input] = ReadJobs(args[0]);
+    // Tuned CP-SAT parameters of the nearest instance, the defaults without a config file
+    const CPConfig config = LoadCPConfig(config_file, Features(input, l));
+    // Solve on composite operations, expand them again before writing
+    std::vector<Job> jobs = contract ? ContractChains(input, chains) : input;
 
+    // Every schedule is left-shifted before it is compared and written. The
+    // expanded one once more, since chain members may then move on their own.
+    long double best = std::numeric_limits<long double>::infinity();
+    auto write_if_better = [&]() {
+        std::vector<Job> out = ExpandChains(input, jobs, chains);
+        const long double expanded = contract ? LeftShift(out, l) : CalculateScore(out);
+        if (expanded < best) {
+            best = expanded;
+            WriteSchedule(args[1], out);
+        }
+        return expanded;
+    };
     TradSpan = TraditionalScheduling(jobs, l);
-    score2 = score = CalculateScore(jobs);
-    WriteSchedule(argv[2], jobs);
+    score = LeftShift(jobs, l);
+    std::cout << "Trad:   " <<  std::fixed << std::setprecision(8) << write_if_better() << '\n';
+
+    RunPS_GA(jobs, l, ga);
+    score = std::min(score, LeftShift(jobs, l));
+    std::cout << "GA:     " <<  std::fixed << std::setprecision(8) << write_if_better() << '\n';
 
     for(auto j : jobs) m += j.ops.size();
     if(l >= 2) {
         if (l >= 6 && jobs.size() >= 8 && score < 10000.0) return 0;
-        PS_CP = operations_research::sat::RunPS_CP(jobs, l, score, TradSpan*1.5);
+        // Generate the disjunctions lazily when the full model is too large to build
+        lazy = lazy || m * l > 2000;
+        // The best schedule so far becomes the CP hint. The race lasts the CP
+        // time limit, or the MIP one capped at 120 s if that is longer.
+        std::vector<std::unique_ptr<operations_research::PSBackend>> backends;
+        backends.emplace_back(new operations_research::CPSATBackend(true, cache, lazy, config));
+        double budget = timeLimit(l, m, false);
+        if (mip != "none") {
+            backends.emplace_back(new operations_research::MIPBackend(mip));
+            budget = std::max(budget, std::min<double>(timeLimit(l, m, true), 120));
+        }
+        if (!export_file.empty()) backends.emplace_back(new operations_research::ModelExportBackend(export_file));
+        PS_CP = operations_research::RacePS(backends, jobs, l, score, TradSpan*1.5, budget, !contract);
         PS_CP_OK = PS_CP == operations_research::sat::CpSolverStatus::OPTIMAL ||
                     PS_CP == operations_research::sat::CpSolverStatus::FEASIBLE;
-        if(PS_CP_OK && (score2 = CalculateScore(jobs)) < score)
-            WriteSchedule(argv[2], jobs);
+        if(PS_CP_OK) {
+            LeftShift(jobs, l);
+            write_if_better();
+        }
     }
-
-    std::cout << "Trad:   " <<  std::fixed << std::setprecision(8) << score << '\n';
-    if(PS_CP_OK)
-        std::cout << "CP-SAT: " <<  std::fixed << std::setprecision(8) << score2 << '\n';
 }
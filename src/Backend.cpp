@@ -0,0 +1,106 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "PS.h"
+
+namespace operations_research {
+// A backend schedules the jobs in place. It must return soon after *stop
+// turns true; a result is only used if the status is OPTIMAL or FEASIBLE.
+class PSBackend {
+  public:
+    virtual ~PSBackend() = default;
+    virtual std::string Name() const = 0;
+    virtual sat::CpSolverStatus Solve(std::vector<Job> &jobs, const uint16_t &l, const long double &bound,
+                                      const uint32_t &span, std::atomic<bool> *stop) = 0;
+};
+
+class CPSATBackend : public PSBackend {
+  public:
+    CPSATBackend(const bool &hint, const std::string &cache, const bool &lazy, const CPConfig &config)
+        : hint(hint), cache(cache), lazy(lazy), config(config) {}
+    std::string Name() const override { return "CP-SAT"; }
+    sat::CpSolverStatus Solve(std::vector<Job> &jobs, const uint16_t &l, const long double &bound,
+                              const uint32_t &span, std::atomic<bool> *stop) override {
+        return sat::RunPS_CP(jobs, l, bound, span, hint, cache, lazy, config, stop);
+    }
+
+  private:
+    const bool hint;
+    const std::string cache;
+    const bool lazy;
+    const CPConfig config;
+};
+
+class MIPBackend : public PSBackend {
+  public:
+    explicit MIPBackend(const std::string &solver_id) : solver_id(solver_id) {}
+    std::string Name() const override { return "MIP-" + solver_id; }
+    sat::CpSolverStatus Solve(std::vector<Job> &jobs, const uint16_t &l, const long double &bound,
+                              const uint32_t &span, std::atomic<bool> *stop) override {
+        return RunPS_MIP(jobs, l, bound, span, solver_id, stop);
+    }
+
+  private:
+    const std::string solver_id;
+};
+
+// Only writes the MIP model to an LP/MPS file, never a schedule
+class ModelExportBackend : public PSBackend {
+  public:
+    explicit ModelExportBackend(const std::string &file) : file(file) {}
+    std::string Name() const override { return "Export"; }
+    sat::CpSolverStatus Solve(std::vector<Job> &jobs, const uint16_t &l, const long double &bound,
+                              const uint32_t &span, std::atomic<bool> *) override {
+        if(!ExportPS_MIP(jobs, l, bound, span, file)) std::cerr << "Cannot export " << file << "\n";
+        return sat::CpSolverStatus::UNKNOWN;
+    }
+
+  private:
+    const std::string file;
+};
+
+// Runs every backend on its own copy of the jobs for at most budget seconds,
+// less if one of them proves optimality. The best schedule is written back to
+// the jobs. On contracted jobs (exact = false) an optimum is only reported as
+// FEASIBLE.
+sat::CpSolverStatus RacePS(std::vector<std::unique_ptr<PSBackend>> &backends, std::vector<Job> &jobs,
+                           const uint16_t &l, const long double &bound, const uint32_t &span,
+                           const double &budget, const bool &exact = true) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> running{backends.size()};
+    std::vector<std::vector<Job>> result(backends.size(), jobs);
+    std::vector<sat::CpSolverStatus> status(backends.size(), sat::CpSolverStatus::UNKNOWN);
+    std::vector<std::thread> threads;
+    for(size_t k = 0; k < backends.size(); k++) threads.emplace_back([&, k] {
+        status[k] = backends[k]->Solve(result[k], l, bound, span, &stop);
+        if(status[k] == sat::CpSolverStatus::OPTIMAL && !exact) status[k] = sat::CpSolverStatus::FEASIBLE;
+        if(status[k] == sat::CpSolverStatus::OPTIMAL) stop = true;
+        --running;
+    });
+    std::thread timer([&] {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(budget);
+        while(running && !stop && std::chrono::steady_clock::now() < end)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        stop = true;
+    });
+    for(auto &t : threads) t.join();
+    timer.join();
+
+    int best = -1;
+    long double best_score = std::numeric_limits<long double>::infinity();
+    for(size_t k = 0; k < backends.size(); k++) {
+        if(status[k] != sat::CpSolverStatus::OPTIMAL && status[k] != sat::CpSolverStatus::FEASIBLE) continue;
+        const long double score = CalculateScore(result[k]);
+        std::cout << backends[k]->Name() << ": " << std::fixed << std::setprecision(8) << score
+                  << (status[k] == sat::CpSolverStatus::OPTIMAL ? " (Opt)\n" : "\n");
+        if(score < best_score) {
+            best = k;
+            best_score = score;
+        }
+    }
+    if(best < 0) return sat::CpSolverStatus::UNKNOWN;
+    jobs.swap(result[best]);
+    return status[best];
+}
+} // namespace operations_research
@@ -1,147 +1,364 @@
+#include <chrono>
+#include <set>
+#include <unordered_map>
 #include "ortools/sat/cp_model.h"
 #include "ortools/sat/cp_model_checker.h"
+#include "ortools/util/time_limit.h"
 #include "PS.h"
 
 namespace operations_research {
 namespace sat {
-CpSolverStatus RunPS_CP(std::vector<Job> &jobs, const uint16_t &l, const long double &bound, const uint32_t &span) {
+// Writes the CpModelProto directly: anonymous variables, one variable per
+// distinct constant and fixed-size intervals in place of xe == xs + d
+class PSModelBuilder {
+  public:
+    static constexpr int64 kMin = std::numeric_limits<int64>::min();
+    static constexpr int64 kMax = std::numeric_limits<int64>::max();
+    CpModelProto proto;
+
+    static int Not(const int &lit) { return -lit - 1; }
+    int NewVar(const int64 &lb, const int64 &ub) {
+        IntegerVariableProto *v = proto.add_variables();
+        v->add_domain(lb);
+        v->add_domain(ub);
+        return proto.variables_size() - 1;
+    }
+    int NewBool() { return NewVar(0, 1); }
+    int Constant(const int64 &value) {
+        auto it = constants.find(value);
+        if(it != constants.end()) return it->second;
+        return constants[value] = NewVar(value, value);
+    }
+    // lb <= sum(coeffs * vars) <= ub if all the literals hold
+    LinearConstraintProto* AddLinear(const std::vector<int> &vars, const std::vector<int64> &coeffs,
+                                     const int64 &lb, const int64 &ub, const std::vector<int> &enforcement = {}) {
+        ConstraintProto *ct = proto.add_constraints();
+        for(auto &e : enforcement) ct->add_enforcement_literal(e);
+        LinearConstraintProto *lin = ct->mutable_linear();
+        for(size_t k = 0; k < vars.size(); k++) {
+            lin->add_vars(vars[k]);
+            lin->add_coeffs(coeffs[k]);
+        }
+        lin->add_domain(lb);
+        lin->add_domain(ub);
+        return lin;
+    }
+    // a >= b + offset
+    void AddGreaterOrEqual(const int &a, const int &b, const int64 &offset, const std::vector<int> &enforcement = {}) {
+        AddLinear({a, b}, {1, -1}, offset, kMax, enforcement);
+    }
+    int AddInterval(const int &start, const int &end, const int64 &size) {
+        IntervalConstraintProto *iv = proto.add_constraints()->mutable_interval();
+        iv->set_start(start);
+        iv->set_end(end);
+        iv->set_size(Constant(size));
+        return proto.constraints_size() - 1;
+    }
+    void AddMaxEquality(const int &target, const std::vector<int> &vars) {
+        IntegerArgumentProto *arg = proto.add_constraints()->mutable_int_max();
+        arg->set_target(target);
+        for(auto &v : vars) arg->add_vars(v);
+    }
+    void AddHint(const int &var, const int64 &value) {
+        proto.mutable_solution_hint()->add_vars(var);
+        proto.mutable_solution_hint()->add_values(value);
+    }
+
+  private:
+    std::unordered_map<int64, int> constants;
+};
+
+// The group models may be cached on disk as "<cache>.g<k>.pb" for repeated
+// runs and offline tuning. Constraint 0 (objective bound) and constraints
+// 1 ~ l*N (slice barriers) are patched after loading, everything else must
+// match the fingerprint stored in the proto name: the sizes, the jobs of the
+// group and a hash of the instance.
+CpSolverStatus RunPS_CP(std::vector<Job> &jobs, const uint16_t &l, const long double &bound, const uint32_t &span,
+                        const bool &hint = false, const std::string &cache = "", const bool &lazy = false,
+                        const CPConfig &config = CPConfig(), std::atomic<bool> *stop = nullptr) {
     int64 Bound;
-    uint32_t dGCD, wGCD{1000000}, V{0}, tLimit;
+    uint32_t wGCD{1000000};
     uint16_t m{0}, Group_start, Group_size, i, j, q;
-    char name[32];
-    bool use_interval = false;
-    std::vector<Operation*> Ops;
+    const OpIndex idx = IndexOperations(jobs);
+    const std::vector<Operation*> &Ops = idx.ops;
+    const uint32_t dGCD = idx.dGCD, V = idx.V;
     std::vector<uint32_t> w, slice_end(l, 0);
     std::vector<uint16_t> j_order(jobs.size()), o_order;
+    std::vector<int64> hint_start;
+    std::vector<bool> hint_y;
 
-    dGCD = jobs[0].ops[0].duration;
-    for(i = 0; i < jobs.size(); i++)
-        for(j = 0; j < jobs[i].ops.size(); j++) {
-            dGCD = std::__gcd(dGCD, jobs[i].ops[j].duration);
-            jobs[i].ops[j].ij = Ops.size();
-            Ops.push_back(&jobs[i].ops[j]);
-        }
-    for(i = 0; i < jobs.size(); i++)
-        for(j = 0; j < jobs[i].ops.size(); j++)
-            V += jobs[i].ops[j].duration / dGCD;
     for(i = 0; i < jobs.size(); i++) {
         w.push_back(std::round(jobs[i].weight*1000000.0));
         wGCD = std::__gcd(wGCD, w.back());
     }
+    // Remember the incoming schedule before the groups overwrite it
+    if(hint) for(auto op : Ops) {
+        hint_start.push_back(op->start_time / dGCD);
+        for(q = 0; q < l; q++)
+            hint_y.push_back(op->in_slice.find(q) != std::basic_string<uint8_t>::npos);
+    }
     Bound = ((int64)std::ceil(bound*1000000.0)) / dGCD / wGCD;
     LOG(INFO) << "Bound = " << Bound << " Span <= " << span << "\n";
 
-    // Sort the jobs by weight in descending order
+    // Sort the jobs by weight (or weight / duration) in descending order, or by duration
     o_order.resize(Ops.size());
     for(i = 0; i < jobs.size(); i++) j_order[i] = i;
-    std::sort(j_order.begin(), j_order.end(), [&](const uint16_t &a, const uint16_t &b) {
+    std::stable_sort(j_order.begin(), j_order.end(), [&](const uint16_t &a, const uint16_t &b) {
+        if(config.order == "ratio") return jobs[a].weight * jobs[b].duration > jobs[b].weight * jobs[a].duration;
+        if(config.order == "duration") return jobs[a].duration < jobs[b].duration;
         return jobs[a].weight > jobs[b].weight;
     });
+    // FNV-1a of everything the model is built from: scaled weights, durations,
+    // slices and dependencies (heads, tails and the pruning follow from them)
+    uint64_t instance_hash = 14695981039346656037ULL;
+    auto mix = [&](const uint64_t &v) { instance_hash = (instance_hash ^ v) * 1099511628211ULL; };
+    for(i = 0; i < jobs.size(); i++) {
+        mix(w[i]);
+        mix(jobs[i].ops.size());
+        for(auto &op : jobs[i].ops) {
+            mix(op.duration);
+            mix(op.slices);
+            mix(op.deps.size());
+            for(auto &d : op.deps) mix(d);
+        }
+    }
     m = 0;
     for(i = 0; i < j_order.size(); i++) for (j = 0; j < jobs[j_order[i]].opTopo.size(); j++)
         o_order[jobs[j_order[i]].ops[jobs[j_order[i]].opTopo[j]].ij] = m++;
 
-    Group_size = (l >= 9) ? 12 : (l >= 6) ? 20 : jobs.size();
+    // Variable layout: makespan, then (start, end, y_1 ~ y_l) per operation, then c per job
+    const int N = Ops.size(), Cmax = 0;
+    const int64 horizon = std::min<uint32_t>(V, span);
+
+    auto xs = [&](const int &o) { return 1 + o*(2+l); };
+    auto xe = [&](const int &o) { return 2 + o*(2+l); };
+    auto y = [&](const int &o, const int &s) { return 3 + o*(2+l) + s; };
+    auto c = [&](const int &job) { return 1 + N*(2+l) + job; };
+
+    Group_size = config.group_size ? config.group_size : (l >= 9) ? 12 : (l >= 6) ? 20 : jobs.size();
     CpSolverStatus GlobalStatus;
     for(Group_start = 0; Group_start < jobs.size(); Group_start+=Group_size) {
+        // Stopped by another backend: the later groups would stay unscheduled
+        if(stop && *stop) return CpSolverStatus::UNKNOWN;
+        const uint16_t Group_end = std::min<uint16_t>(Group_start+Group_size, jobs.size());
         std::cerr << "CP job group " << (Group_start+1) << " ~ " << (Group_start+Group_size) << "\n";
-        CpModelBuilder cp_model;
-        // Variables
-        std::vector<IntVar> c, xs, xe;
-        std::vector<IntervalVar> xinterval[l];
-        std::vector<BoolVar> y, z;
-        const Domain time(0, std::min<uint32_t>(V, span));
-        const IntVar Cmax{cp_model.NewIntVar(time).WithName("makespan")};
-        uint16_t ij{0};
-        for(i = 0; i < jobs.size(); i++) {
-            for(j = 0; j < jobs[i].ops.size(); j++) {
-                std::snprintf(name, sizeof(name), "start_%d", ++ij);
-                xs.push_back(cp_model.NewIntVar(time).WithName(name));
-                std::snprintf(name, sizeof(name), "end_%d", ij);
-                xe.push_back(cp_model.NewIntVar(time).WithName(name));
-                for(q = 0; q < l; q++) {
-                    std::snprintf(name, sizeof(name), "y_%d_%d", ij, q+1);
-                    y.push_back(cp_model.NewBoolVar().WithName(name));
-                }
+        std::stringstream fingerprint;
+        fingerprint << "PS l=" << l << " n=" << jobs.size() << " ops=" << N << " group=" << Group_start
+                    << "+" << Group_size << " horizon=" << horizon << " d=" << dGCD << " w=" << wGCD << " lazy=" << lazy
+                    << " order=" << config.order << " jobs=";
+        for(i = Group_start; i < Group_end; i++) fingerprint << j_order[i] << ",";
+        fingerprint << " hash=" << std::hex << instance_hash;
+        const std::string cache_file = cache.empty() ? "" : cache + ".g" + std::to_string(Group_start/Group_size) + ".pb";
+
+        PSModelBuilder cp_model;
+        CpModelProto &proto = cp_model.proto;
+        // Disjunctive, only for the pairs whose order is still open. Operations
+        // outside the group are unconstrained, so their pairs are dropped too.
+        std::vector<bool> in_group(N, false);
+        uint32_t pairs{0}, forced{0}, apart{0};
+        for(i = Group_start; i < Group_end; i++)
+            for(auto &op : jobs[j_order[i]].ops) in_group[op.ij] = true;
+        auto add_pair = [&](const int &a, const int &b) {
+            if(idx.Precedes(a, b) || idx.Precedes(b, a)) {
+                const int u = idx.Precedes(a, b) ? a : b, v = a + b - u;
+                const auto &deps = Ops[v]->deps;
+                if(std::find(deps.begin(), deps.end(), idx.local[u]) == deps.end())
+                    cp_model.AddGreaterOrEqual(xs(v), xe(u), 0);
+                forced++;
+                return;
             }
-            std::snprintf(name, sizeof(name), "c_%d", i+1);
-            c.push_back(cp_model.NewIntVar(time).WithName(name));
-        }
-        std::cerr << "C " << c.size() << " X " << xs.size() <<  " " << xe.size();
-        std::cerr << " Y " << y.size() << "\n";
-        // Constraints
-        for(i = Group_start; i < std::min<uint16_t>(Group_start+Group_size,jobs.size()); i++) {
-            std::vector<IntVar> op_ends;
-            std::cerr << "Job " << (j_order[i]+1) << "\n";
-            // Disjunctive and Width
-            for(j = 0; j < jobs[j_order[i]].ops.size(); j++) {
-                const IntVar Duration = cp_model.NewConstant(jobs[j_order[i]].ops[j].duration/dGCD);
-                ij = jobs[j_order[i]].ops[j].ij;
-                std::cerr << "Operation " << (j+1) << " (" << (ij+1) << ")\n";
-                std::vector<BoolVar> slice_bools(y.begin()+(ij*l), y.begin()+((ij+1)*l));
-                cp_model.AddEquality(LinearExpr::BooleanSum(slice_bools), cp_model.NewConstant(jobs[j_order[i]].ops[j].slices));
-                op_ends.push_back(xe[ij]);
+            if(idx.Apart(a, b, horizon)) {
+                apart++;
+                return;
             }
-            // Precedence
-            for(j = 0; j < jobs[j_order[i]].ops.size(); j++) for(auto &d : jobs[j_order[i]].ops[j].deps)
-                cp_model.AddGreaterOrEqual(xs[jobs[j_order[i]].ops[j].ij], xe[jobs[j_order[i]].ops[d].ij]);
-            cp_model.AddMaxEquality(c[j_order[i]], op_ends);
-        }
-        for(i = 0; i < Ops.size(); i++)
-            cp_model.AddEquality(xe[i], xs[i].AddConstant(Ops[i]->duration/dGCD));
-        for(q = 0; q < l; q++) {
-            const IntVar slice_per_end = cp_model.NewConstant(slice_end[q]);
-            for(i = 0; i < Ops.size(); i++)
-                cp_model.AddGreaterOrEqual(xs[i], slice_per_end).OnlyEnforceIf(y[i*l+q]);
+            pairs++;
+            const int z = cp_model.NewBool();
+            if(Ops[a]->slices + Ops[b]->slices > l) {
+                cp_model.AddGreaterOrEqual(xs(b), xe(a), 0, {z});
+                cp_model.AddGreaterOrEqual(xs(a), xe(b), 0, {PSModelBuilder::Not(z)});
+            } else for(uint16_t s = 0; s < l; s++) {
+                cp_model.AddGreaterOrEqual(xs(b), xe(a), 0, {y(a, s), y(b, s), z});
+                cp_model.AddGreaterOrEqual(xs(a), xe(b), 0, {y(a, s), y(b, s), PSModelBuilder::Not(z)});
+            }
+        };
+        bool cached = false;
+        if(!cache_file.empty()) {
+            std::ifstream in(cache_file, std::ios::binary);
+            cached = in && proto.ParseFromIstream(&in) && proto.name() == fingerprint.str();
+            if(!cached) proto.Clear();
         }
-        for(i = 0; i < Ops.size()-1; i++) for(j = i+1; j < Ops.size(); j++) {
-            z.push_back(cp_model.NewBoolVar());
-            if(Ops[i]->slices + Ops[j]->slices > l) {
-                cp_model.AddGreaterOrEqual(xs[j], xe[i]).OnlyEnforceIf(z.back());
-                cp_model.AddGreaterOrEqual(xs[i], xe[j]).OnlyEnforceIf(z.back().Not());
-            } else for(q = 0; q < l; q++) {
-                cp_model.AddGreaterOrEqual(xs[j], xe[i]).OnlyEnforceIf({y[i*l+q], y[j*l+q], z.back()});
-                cp_model.AddGreaterOrEqual(xs[i], xe[j]).OnlyEnforceIf({y[i*l+q], y[j*l+q], z.back().Not()});
+        if(!cached) {
+            // Variables
+            cp_model.NewVar(0, horizon);
+            for(i = 0; i < N; i++) {
+                const int64 d = Ops[i]->duration/dGCD;
+                cp_model.NewVar(idx.head[i], horizon - idx.tail[i] - d);
+                cp_model.NewVar(idx.head[i] + d, horizon - idx.tail[i]);
+                for(q = 0; q < l; q++) cp_model.NewBool();
             }
+            std::vector<int> obj_vars{Cmax}, c_vars;
+            std::vector<int64> obj_coeffs{1000000/wGCD};
+            for(i = 0; i < jobs.size(); i++) {
+                c_vars.push_back(cp_model.NewVar(0, horizon));
+                obj_vars.push_back(c_vars.back());
+                obj_coeffs.push_back(w[i]/wGCD);
+            }
+            // Patched header: objective bound and slice barriers
+            cp_model.AddLinear(obj_vars, obj_coeffs, PSModelBuilder::kMin, Bound);
+            for(q = 0; q < l; q++) for(i = 0; i < N; i++)
+                cp_model.AddLinear({xs(i)}, {1}, slice_end[q], PSModelBuilder::kMax, {y(i, q)});
+            // Constraints
+            for(i = Group_start; i < Group_end; i++) {
+                const Job &job = jobs[j_order[i]];
+                std::vector<int> op_ends;
+                // Width
+                for(j = 0; j < job.ops.size(); j++) {
+                    const int ij = job.ops[j].ij;
+                    std::vector<int> slice_bools;
+                    for(q = 0; q < l; q++) slice_bools.push_back(y(ij, q));
+                    cp_model.AddLinear(slice_bools, std::vector<int64>(l, 1), job.ops[j].slices, job.ops[j].slices);
+                    op_ends.push_back(xe(ij));
+                }
+                // Precedence
+                for(j = 0; j < job.ops.size(); j++) for(auto &d : job.ops[j].deps)
+                    cp_model.AddGreaterOrEqual(xs(job.ops[j].ij), xe(job.ops[d].ij), 0);
+                cp_model.AddMaxEquality(c(j_order[i]), op_ends);
+            }
+            const int interval_begin = proto.constraints_size();
+            for(i = 0; i < N; i++)
+                cp_model.AddInterval(xs(i), xe(i), Ops[i]->duration/dGCD);
+            if(lazy) {
+                // Relaxation: the slices as a single resource of capacity l
+                CumulativeConstraintProto *cumul = proto.add_constraints()->mutable_cumulative();
+                cumul->set_capacity(cp_model.Constant(l));
+                for(i = 0; i < N; i++) if(in_group[i]) {
+                    cumul->add_intervals(interval_begin + i);
+                    cumul->add_demands(cp_model.Constant(Ops[i]->slices));
+                }
+            } else for(i = 0; i < N-1; i++) for(j = i+1; j < N; j++)
+                if(in_group[i] && in_group[j]) add_pair(i, j);
+            std::cerr << "Disjunctive pairs " << pairs << " forced " << forced << " apart " << apart << "\n";
+            cp_model.AddMaxEquality(Cmax, c_vars);
+            for(size_t k = 0; k < obj_vars.size(); k++) {
+                proto.mutable_objective()->add_vars(obj_vars[k]);
+                proto.mutable_objective()->add_coeffs(obj_coeffs[k]);
+            }
+            proto.set_name(fingerprint.str());
+            if(!cache_file.empty()) {
+                std::ofstream out(cache_file, std::ios::binary);
+                proto.SerializeToOstream(&out);
+            }
+        } else std::cerr << "Loaded " << cache_file << "\n";
+
+        proto.mutable_constraints(0)->mutable_linear()->set_domain(1, Bound);
+        for(q = 0; q < l; q++) for(i = 0; i < N; i++)
+            proto.mutable_constraints(1 + q*N + i)->mutable_linear()->set_domain(0, slice_end[q]);
+        proto.clear_solution_hint();
+        if(hint) for(i = 0; i < N; i++) {
+            cp_model.AddHint(xs(i), hint_start[i]);
+            cp_model.AddHint(xe(i), hint_start[i] + Ops[i]->duration/dGCD);
+            for(q = 0; q < l; q++) cp_model.AddHint(y(i, q), hint_y[i*l+q]);
         }
 
-        cp_model.AddMaxEquality(Cmax, c);
-        LinearExpr obj;
-        obj.AddTerm(Cmax, 1000000/wGCD);
-        for(i = 0; i < c.size(); i++) obj.AddTerm(c[i], w[i]/wGCD);
-        cp_model.AddLessOrEqual(Cmax, span);
-        cp_model.AddLessOrEqual(obj, Bound);
-        cp_model.Minimize(obj);
+        std::cerr << proto.variables_size() << " variables ";
+        std::cerr << proto.constraints_size() << " constraints\n";
+#ifndef PS_NO_VALIDATE
+        std::cerr << ValidateCpModel(proto) << "\n";
+#endif
+        // Lazy mode: solve, look for slice overlaps with a sweep-line, add the
+        // disjunctions of the conflicting pairs only and re-solve warm-started.
+        // A round gets a quarter of the remaining time, a conflict-free but
+        // unproven solution all of it. The best conflict-free solution found
+        // by any round is kept for when the time runs out.
+        const double tLimit = (config.max_time > 0 ? config.max_time : timeLimit(l, Ops.size(), false))
+                              *(1.0)*(Group_end - Group_start)/jobs.size();
+        const auto tStart = std::chrono::steady_clock::now();
+        auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count(); };
+        auto overlaps = [&](const CpSolverResponse &r) {
+            std::vector<std::pair<int, int>> found;
+            for(uint16_t s = 0; s < l; s++) {
+                std::vector<std::pair<int64, int>> on_slice, active;
+                for(int o = 0; o < N; o++) if(in_group[o] && r.solution(y(o, s)))
+                    on_slice.emplace_back(r.solution(xs(o)), o);
+                std::sort(on_slice.begin(), on_slice.end());
+                for(auto &[start, o] : on_slice) {
+                    // Keep the operations still running at this start
+                    active.erase(std::remove_if(active.begin(), active.end(), [&](const std::pair<int64, int> &a) {
+                        return a.first <= start;
+                    }), active.end());
+                    for(auto &a : active) found.emplace_back(std::min(a.second, o), std::max(a.second, o));
+                    active.emplace_back(r.solution(xe(o)), o);
+                }
+            }
+            return found;
+        };
+        std::set<std::pair<int, int>> added;
+        CpSolverResponse response, fallback;
+        bool conflict_free = !lazy, whole_budget = !lazy;
+        for(;;) {
+            Model model;
+            model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& r) {
+                LOG(INFO) << "Solution makespan " << r.solution(Cmax)
+                        << " objective " << r.objective_value();
+                if(lazy && (fallback.solution_size() == 0 || r.objective_value() < fallback.objective_value())
+                   && overlaps(r).empty()) fallback = r;
+            }));
 
-        std::cerr << cp_model.Proto().variables_size() << " variables ";
-        std::cerr << cp_model.Proto().constraints_size() << " constraints\n";
-        std::cerr << ValidateCpModel(cp_model.Proto()) << "\n";
-        Model model;
-        model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& r) {
-            LOG(INFO) << "Solution makespan " << SolutionIntegerValue(r, Cmax)
-                    << " objective " << SolutionIntegerValue(r, obj);
-        }));
+            SatParameters parameters;
+            parameters.set_num_search_workers(config.workers);
+            if(config.search_branching >= 0)
+                parameters.set_search_branching(static_cast<SatParameters::SearchBranching>(config.search_branching));
+            if(config.linearization_level >= 0) parameters.set_linearization_level(config.linearization_level);
+            parameters.set_enumerate_all_solutions(false);
+            const double remaining = tLimit - elapsed();
+            parameters.set_max_time_in_seconds(std::max(whole_budget ? remaining : remaining / 4, 1.0));
+            model.Add(NewSatParameters(parameters));
+            if(stop) model.GetOrCreate<TimeLimit>()->RegisterExternalBooleanAsLimit(stop);
+            response = SolveCpModel(proto, &model);
+            LOG(INFO) << CpSolverResponseStats(response);
+            GlobalStatus = response.status();
+            if(!lazy) break;
+            const bool out_of_time = elapsed() >= tLimit || (stop && *stop);
+            if(GlobalStatus != CpSolverStatus::OPTIMAL && GlobalStatus != CpSolverStatus::FEASIBLE) {
+                // Nothing within the round: retry with all the time left
+                conflict_free = false;
+                if(GlobalStatus != CpSolverStatus::UNKNOWN || out_of_time) break;
+                whole_budget = true;
+                continue;
+            }
 
-        SatParameters parameters;
-        parameters.set_num_search_workers(32);
-        parameters.set_enumerate_all_solutions(false);
-        parameters.set_max_time_in_seconds(timeLimit(l, Ops.size(), false)*(1.0)*Group_size/jobs.size());
-        model.Add(NewSatParameters(parameters));
-        const CpSolverResponse response = SolveCpModel(cp_model.Build(), &model);
-        LOG(INFO) << CpSolverResponseStats(response);
-        if((GlobalStatus = response.status()) == CpSolverStatus::OPTIMAL || GlobalStatus == CpSolverStatus::FEASIBLE)
-            for(i = Group_start; i < std::min<uint16_t>(Group_start+Group_size,jobs.size()); i++)
+            std::vector<std::pair<int, int>> conflicts;
+            for(auto &pair : overlaps(response)) if(added.insert(pair).second) conflicts.push_back(pair);
+            std::cerr << "Lazy round: " << conflicts.size() << " conflicting pairs\n";
+            conflict_free = conflicts.empty();
+            if((conflict_free && GlobalStatus == CpSolverStatus::OPTIMAL) || out_of_time) break;
+            for(auto &[a, b] : conflicts) add_pair(a, b);
+            whole_budget = conflict_free;
+            proto.clear_solution_hint();
+            for(int k = 0; k < response.solution_size(); k++) cp_model.AddHint(k, response.solution(k));
+        }
+        if(lazy && !conflict_free) {
+            if(fallback.solution_size() > 0) {
+                response = fallback;
+                GlobalStatus = CpSolverStatus::FEASIBLE;
+            } else if(GlobalStatus == CpSolverStatus::OPTIMAL || GlobalStatus == CpSolverStatus::FEASIBLE)
+                GlobalStatus = CpSolverStatus::UNKNOWN;
+        }
+        if(GlobalStatus == CpSolverStatus::OPTIMAL || GlobalStatus == CpSolverStatus::FEASIBLE)
+            for(i = Group_start; i < Group_end; i++)
                 for(j = 0; j < jobs[j_order[i]].ops.size(); j++) {
                     Operation* op = &jobs[j_order[i]].ops[j];
-                    op->start_time = SolutionIntegerValue(response, xs[op->ij]) * dGCD;
+                    op->start_time = response.solution(xs(op->ij)) * dGCD;
                     op->in_slice.clear();
-                    for(q = 0; q < l; q++) if(SolutionIntegerValue(response, y[op->ij*l+q])) {
+                    for(q = 0; q < l; q++) if(response.solution(y(op->ij, q))) {
                         op->in_slice.push_back(q);
-                        slice_end[q] = std::max<uint32_t>(slice_end[q], SolutionIntegerValue(response, xe[op->ij]));
+                        slice_end[q] = std::max<uint32_t>(slice_end[q], response.solution(xe(op->ij)));
                     }
                 }
         else return GlobalStatus;
     }
+    // An optimal group proves nothing about the whole instance
+    if(GlobalStatus == CpSolverStatus::OPTIMAL && Group_size < jobs.size()) return CpSolverStatus::FEASIBLE;
     return GlobalStatus;
 }
 } // namespace sat
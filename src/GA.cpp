@@ -0,0 +1,276 @@
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <deque>               // for deque
+#include <functional>          // for function
+#include <mutex>               // for mutex, lock_guard, unique_lock
+#include <numeric>             // for iota
+#include <queue>               // for priority_queue
+#include <random>              // for mt19937_64, uniform_real_distribution
+#include <thread>              // for thread
+#include "PS.h"
+
+namespace {
+
+// Every worker owns a deque: it pops its own tasks from the back and steals
+// from the front of the others once it runs dry.
+class WorkStealingPool {
+  public:
+    explicit WorkStealingPool(uint16_t n) : queues(n) {
+        for (uint16_t t = 0; t < n; t++) workers.emplace_back([this, t] { Work(t); });
+    }
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto &w : workers) w.join();
+    }
+    // Run all the tasks and block until every one of them is finished
+    void Run(std::vector<std::function<void()>> &tasks) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            for (size_t i = 0; i < tasks.size(); i++) {
+                Queue &qu = queues[i % queues.size()];
+                std::lock_guard<std::mutex> qlock(qu.m);
+                qu.tasks.push_back(&tasks[i]);
+            }
+            queued += tasks.size();
+            pending += tasks.size();
+        }
+        wake.notify_all();
+        std::unique_lock<std::mutex> lock(m);
+        finished.wait(lock, [&] { return pending == 0; });
+    }
+
+  private:
+    struct Queue {
+        std::mutex m;
+        std::deque<std::function<void()>*> tasks;
+    };
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable wake, finished;
+    std::atomic<size_t> queued{0};
+    size_t pending{0};
+    bool stop{false};
+
+    std::function<void()>* Take(const uint16_t &t) {
+        for (uint16_t k = 0; k < queues.size(); k++) {
+            Queue &qu = queues[(t + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(qu.m);
+            if (qu.tasks.empty()) continue;
+            std::function<void()>* task;
+            if (k == 0) {
+                task = qu.tasks.back();
+                qu.tasks.pop_back();
+            } else {
+                task = qu.tasks.front();
+                qu.tasks.pop_front();
+            }
+            --queued;
+            return task;
+        }
+        return nullptr;
+    }
+    void Work(const uint16_t t) {
+        for (;;) {
+            if (std::function<void()>* task = Take(t)) {
+                (*task)();
+                std::lock_guard<std::mutex> lock(m);
+                if (--pending == 0) finished.notify_all();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m);
+            wake.wait(lock, [&] { return stop || queued > 0; });
+            if (stop) return;
+        }
+    }
+};
+
+// A chromosome holds one key per job followed by one key per operation.
+// Ready operations are dispatched by the highest jobkey + opkey / n, so the
+// job keys decide the coarse order and the operation keys break the ties
+// within (and slightly across) jobs.
+class Decoder {
+  public:
+    std::vector<Job> jobs;  // Scratch copy holding the last decoded schedule
+    std::vector<std::pair<uint16_t, uint16_t>> seq;
+
+    Decoder(const std::vector<Job> &jobs_, const uint16_t &l_) : jobs(jobs_), l(l_) {
+        for (uint16_t j = 0; j < jobs.size(); j++) {
+            base.push_back(gene.size());
+            for (uint16_t o = 0; o < jobs[j].ops.size(); o++) gene.emplace_back(j, o);
+        }
+        succ.resize(gene.size());
+        indeg.resize(gene.size());
+        for (uint32_t g = 0; g < gene.size(); g++) {
+            auto &[j, o] = gene[g];
+            indeg[g] = jobs[j].ops[o].deps.size();
+            for (auto &d : jobs[j].ops[o].deps) succ[base[j] + d].push_back(g);
+        }
+    }
+    size_t Size() const { return jobs.size() + gene.size(); }
+    uint32_t Gene(const uint16_t &j, const uint16_t &o) const { return jobs.size() + base[j] + o; }
+
+    long double Decode(const std::vector<double> &keys) {
+        const double n = jobs.size();
+        std::vector<uint16_t> deg(indeg);
+        std::priority_queue<std::pair<double, int64_t>> ready;
+        auto push = [&](const uint32_t &g) {
+            ready.emplace(keys[gene[g].first] + keys[jobs.size() + g] / n, -(int64_t)g);
+        };
+        seq.clear();
+        for (uint32_t g = 0; g < gene.size(); g++) if (!deg[g]) push(g);
+        while (!ready.empty()) {
+            uint32_t g = -ready.top().second;
+            ready.pop();
+            seq.push_back(gene[g]);
+            for (auto &s : succ[g]) if (!--deg[s]) push(s);
+        }
+        ListScheduling(jobs, l, seq);
+        return CalculateScore(jobs);
+    }
+
+  private:
+    const uint16_t l;
+    std::vector<std::pair<uint16_t, uint16_t>> gene;
+    std::vector<uint32_t> base;
+    std::vector<std::vector<uint32_t>> succ;
+    std::vector<uint16_t> indeg;
+};
+
+struct Island {
+    std::mt19937_64 rng;
+    Decoder dec;
+    std::vector<std::vector<double>> pop;  // Sorted by fitness after every generation
+    std::vector<long double> fit;
+
+    Island(const std::vector<Job> &jobs, const uint16_t &l, const uint64_t &seed, const uint16_t &k)
+        : dec(jobs, l) {
+        std::seed_seq seq{seed, (uint64_t)k};
+        rng.seed(seq);
+    }
+    std::vector<double> Random() {
+        std::uniform_real_distribution<double> U(0.0, 1.0);
+        std::vector<double> c(dec.Size());
+        for (auto &k : c) k = U(rng);
+        return c;
+    }
+    void Sort() {
+        std::vector<uint16_t> idx(pop.size());
+        std::iota(idx.begin(), idx.end(), 0);
+        std::stable_sort(idx.begin(), idx.end(), [&](const uint16_t &a, const uint16_t &b) {
+            return fit[a] < fit[b];
+        });
+        std::vector<std::vector<double>> p2;
+        std::vector<long double> f2;
+        for (auto &i : idx) {
+            p2.push_back(std::move(pop[i]));
+            f2.push_back(fit[i]);
+        }
+        pop.swap(p2);
+        fit.swap(f2);
+    }
+    void Evolve(const GAParams &par, const uint16_t &gens) {
+        const uint16_t P = pop.size();
+        const uint16_t ne = std::max<uint16_t>(1, par.elite * P);
+        const uint16_t nm = std::min<uint16_t>(P - ne, par.mutant * P);
+        std::uniform_real_distribution<double> U(0.0, 1.0);
+        std::uniform_int_distribution<uint16_t> E(0, ne - 1), R(ne, std::max<uint16_t>(ne, P - 1));
+        for (uint16_t g = 0; g < gens; g++) {
+            std::vector<std::vector<double>> next(pop.begin(), pop.begin() + ne);
+            while (next.size() < (size_t)(P - nm)) {
+                const std::vector<double> &a = pop[E(rng)], &b = pop[ne < P ? R(rng) : E(rng)];
+                std::vector<double> c(a.size());
+                for (size_t k = 0; k < c.size(); k++) c[k] = (U(rng) < par.rho) ? a[k] : b[k];
+                next.push_back(std::move(c));
+            }
+            while (next.size() < P) next.push_back(Random());
+            fit.resize(ne);
+            for (uint16_t i = ne; i < P; i++) fit.push_back(dec.Decode(next[i]));
+            pop.swap(next);
+            Sort();
+        }
+    }
+};
+
+} // namespace
+
+long double RunPS_GA(std::vector<Job> &jobs, const uint16_t &l, const GAParams &par) {
+    const long double initial = CalculateScore(jobs);
+    const uint16_t T = par.threads ? par.threads : std::max<uint16_t>(1, std::thread::hardware_concurrency());
+    const uint16_t K = par.islands ? par.islands : T;
+    const uint16_t P = std::max<uint16_t>(4, par.population);
+    std::vector<Island> islands;
+    islands.reserve(K);
+    for (uint16_t k = 0; k < K; k++) islands.emplace_back(jobs, l, par.seed, k);
+
+    // Seed every island with the order of TraditionalScheduling and with the incoming schedule
+    const Decoder &d0 = islands[0].dec;
+    std::vector<double> trad(d0.Size(), 0.0), given(d0.Size(), 0.0);
+    std::vector<uint16_t> j_order(jobs.size());
+    std::vector<std::pair<uint16_t, uint16_t>> by_start;
+    std::iota(j_order.begin(), j_order.end(), 0);
+    std::sort(j_order.begin(), j_order.end(), [&](const uint16_t &a, const uint16_t &b) {
+        if (l == 1) return jobs[a].weight * jobs[b].duration > jobs[b].weight * jobs[a].duration;
+        return jobs[a].weight > jobs[b].weight;
+    });
+    for (uint16_t r = 0; r < j_order.size(); r++) {
+        const Job &job = jobs[j_order[r]];
+        trad[j_order[r]] = 1.0 - (double)r / jobs.size();
+        for (uint16_t t = 0; t < job.opTopo.size(); t++) {
+            trad[d0.Gene(j_order[r], job.opTopo[t])] = 1.0 - (double)t / job.opTopo.size();
+            by_start.emplace_back(j_order[r], job.opTopo[t]);
+        }
+    }
+    std::stable_sort(by_start.begin(), by_start.end(), [&](const auto &a, const auto &b) {
+        return jobs[a.first].ops[a.second].start_time < jobs[b.first].ops[b.second].start_time;
+    });
+    for (size_t r = 0; r < by_start.size(); r++)
+        given[d0.Gene(by_start[r].first, by_start[r].second)] = 1.0 - (double)r / by_start.size();
+
+    WorkStealingPool pool(T);
+    std::vector<std::function<void()>> tasks;
+    for (auto &isl : islands) tasks.emplace_back([&] {
+        isl.pop = {trad, given};
+        while (isl.pop.size() < P) isl.pop.push_back(isl.Random());
+        for (auto &c : isl.pop) isl.fit.push_back(isl.dec.Decode(c));
+        isl.Sort();
+    });
+    pool.Run(tasks);
+
+    for (uint16_t gen = 0; gen < par.generations; gen += par.migration) {
+        const uint16_t gens = std::min<uint16_t>(par.migration, par.generations - gen);
+        tasks.clear();
+        for (auto &isl : islands) tasks.emplace_back([&, gens] { isl.Evolve(par, gens); });
+        pool.Run(tasks);
+        // Ring migration: the elites of each island replace the worst of the next one
+        const uint16_t mg = std::min<uint16_t>(par.migrants, P / 2);
+        std::vector<std::vector<double>> elites;
+        std::vector<long double> elite_fit;
+        for (auto &isl : islands) for (uint16_t i = 0; i < mg; i++) {
+            elites.push_back(isl.pop[i]);
+            elite_fit.push_back(isl.fit[i]);
+        }
+        for (uint16_t k = 0; k < K && K > 1; k++) {
+            Island &dst = islands[(k + 1) % K];
+            for (uint16_t i = 0; i < mg; i++) {
+                dst.pop[P - 1 - i] = elites[k * mg + i];
+                dst.fit[P - 1 - i] = elite_fit[k * mg + i];
+            }
+            dst.Sort();
+        }
+        long double best = islands[0].fit[0];
+        for (auto &isl : islands) best = std::min(best, isl.fit[0]);
+        std::cerr << "GA generation " << (gen + gens) << " best " << std::fixed << std::setprecision(8) << best << "\n";
+    }
+
+    uint16_t b = 0;
+    for (uint16_t k = 1; k < K; k++) if (islands[k].fit[0] < islands[b].fit[0]) b = k;
+    if (!(islands[b].fit[0] < initial)) return initial;
+    islands[b].dec.Decode(islands[b].pop[0]);
+    ListScheduling(jobs, l, islands[b].dec.seq);
+    return CalculateScore(jobs);
+}
@@ -0,0 +1,137 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "ortools/linear_solver/linear_solver.h"
+#include "PS.h"
+
+namespace operations_research {
+struct PSMIPModel {
+    std::vector<MPVariable*> x, y, c;
+    MPVariable* Cmax;
+};
+
+// The disjunctive model of disjunctive_model.tex with V = min(V, span) as big-M,
+// one z per pair shared by all the slices, and the pairs pruned as in RunPS_CP.
+// Times are in units of dGCD.
+PSMIPModel BuildPS_MIP(MPSolver &solver, const std::vector<Job> &jobs, const uint16_t &l, const long double &bound,
+                       const uint32_t &span, const OpIndex &idx) {
+    PSMIPModel mdl;
+    const int N = idx.ops.size();
+    const double M = std::min<uint32_t>(idx.V, span);
+    std::vector<double> d(N);
+    for(int i = 0; i < N; i++) d[i] = idx.ops[i]->duration / idx.dGCD;
+
+    MPObjective* const obj = solver.MutableObjective();
+    MPConstraint* const obj_bound = solver.MakeRowConstraint(-solver.infinity(), bound / idx.dGCD);
+    mdl.Cmax = solver.MakeIntVar(0, M, "cmax");
+    obj->SetCoefficient(mdl.Cmax, 1);
+    obj_bound->SetCoefficient(mdl.Cmax, 1);
+    for(int i = 0; i < N; i++) {
+        mdl.x.push_back(solver.MakeIntVar(idx.head[i], M - idx.tail[i] - d[i], "x" + std::to_string(i+1)));
+        MPConstraint* const width = solver.MakeRowConstraint(idx.ops[i]->slices, idx.ops[i]->slices);
+        for(uint16_t q = 0; q < l; q++) {
+            mdl.y.push_back(solver.MakeBoolVar("y" + std::to_string(i+1) + "_" + std::to_string(q+1)));
+            width->SetCoefficient(mdl.y.back(), 1);
+        }
+    }
+    for(uint16_t j = 0; j < jobs.size(); j++) {
+        mdl.c.push_back(solver.MakeIntVar(0, M, "c" + std::to_string(j+1)));
+        obj->SetCoefficient(mdl.c.back(), jobs[j].weight);
+        obj_bound->SetCoefficient(mdl.c.back(), jobs[j].weight);
+        MPConstraint* const cmax = solver.MakeRowConstraint(0, solver.infinity());
+        cmax->SetCoefficient(mdl.Cmax, 1);
+        cmax->SetCoefficient(mdl.c.back(), -1);
+        for(auto &op : jobs[j].ops) {
+            MPConstraint* const ci = solver.MakeRowConstraint(d[op.ij], solver.infinity());
+            ci->SetCoefficient(mdl.c.back(), 1);
+            ci->SetCoefficient(mdl.x[op.ij], -1);
+            for(auto &dep : op.deps) {
+                const int a = jobs[j].ops[dep].ij;
+                MPConstraint* const prec = solver.MakeRowConstraint(d[a], solver.infinity());
+                prec->SetCoefficient(mdl.x[op.ij], 1);
+                prec->SetCoefficient(mdl.x[a], -1);
+            }
+        }
+    }
+    obj->SetMinimization();
+
+    // z = 1 if a precedes b
+    for(int a = 0; a < N-1; a++) for(int b = a+1; b < N; b++) {
+        if(idx.Precedes(a, b) || idx.Precedes(b, a) || idx.Apart(a, b, M)) continue;
+        MPVariable* const z = solver.MakeBoolVar("z" + std::to_string(a+1) + "_" + std::to_string(b+1));
+        auto disjunction = [&](const int &q) {
+            // (4) and (5) on slice q; without a slice D = z and Dbar = 1 - z
+            MPConstraint* const ab = solver.MakeRowConstraint(d[b] - (q < 0 ? 0 : 2*M), solver.infinity());
+            MPConstraint* const ba = solver.MakeRowConstraint(d[a] - (q < 0 ? M : 3*M), solver.infinity());
+            ab->SetCoefficient(mdl.x[a], 1);
+            ab->SetCoefficient(mdl.x[b], -1);
+            ab->SetCoefficient(z, M);
+            ba->SetCoefficient(mdl.x[b], 1);
+            ba->SetCoefficient(mdl.x[a], -1);
+            ba->SetCoefficient(z, -M);
+            if(q >= 0) for(auto ct : {ab, ba}) {
+                ct->SetCoefficient(mdl.y[a*l+q], -M);
+                ct->SetCoefficient(mdl.y[b*l+q], -M);
+            }
+        };
+        if(idx.ops[a]->slices + idx.ops[b]->slices > l) disjunction(-1);
+        else for(uint16_t q = 0; q < l; q++) disjunction(q);
+    }
+    return mdl;
+}
+
+// Solves the model with an OR-Tools MIP backend (e.g. "SCIP" or "CBC") if it is built in
+sat::CpSolverStatus RunPS_MIP(std::vector<Job> &jobs, const uint16_t &l, const long double &bound, const uint32_t &span,
+                              const std::string &solver_id, std::atomic<bool> *stop = nullptr) {
+    const OpIndex idx = IndexOperations(jobs);
+    const int tLimit = timeLimit(l, idx.ops.size(), true);
+    // Too large for the big-M formulation
+    if(tLimit <= 1) return sat::CpSolverStatus::UNKNOWN;
+    std::unique_ptr<MPSolver> solver(MPSolver::CreateSolver(solver_id));
+    if(!solver) {
+        std::cerr << solver_id << " is not available\n";
+        return sat::CpSolverStatus::MODEL_INVALID;
+    }
+    const PSMIPModel mdl = BuildPS_MIP(*solver, jobs, l, bound, span, idx);
+    std::cerr << solver_id << ": " << solver->NumVariables() << " variables "
+              << solver->NumConstraints() << " constraints\n";
+    solver->set_time_limit(tLimit * 1000LL);
+
+    std::atomic<bool> solved{false};
+    std::thread watcher([&] {
+        while(!solved && !(stop && *stop)) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if(!solved) solver->InterruptSolve();
+    });
+    const MPSolver::ResultStatus status = solver->Solve();
+    solved = true;
+    watcher.join();
+    if(status != MPSolver::OPTIMAL && status != MPSolver::FEASIBLE)
+        return status == MPSolver::INFEASIBLE ? sat::CpSolverStatus::INFEASIBLE : sat::CpSolverStatus::UNKNOWN;
+
+    for(size_t i = 0; i < idx.ops.size(); i++) {
+        Operation* op = idx.ops[i];
+        op->start_time = std::llround(mdl.x[i]->solution_value()) * idx.dGCD;
+        op->in_slice.clear();
+        for(uint16_t q = 0; q < l; q++)
+            if(mdl.y[i*l+q]->solution_value() > 0.5) op->in_slice.push_back(q);
+    }
+    return status == MPSolver::OPTIMAL ? sat::CpSolverStatus::OPTIMAL : sat::CpSolverStatus::FEASIBLE;
+}
+
+// Writes the same model in LP format, or MPS if the file name ends with ".mps"
+bool ExportPS_MIP(std::vector<Job> &jobs, const uint16_t &l, const long double &bound, const uint32_t &span,
+                  const std::string &file) {
+    const OpIndex idx = IndexOperations(jobs);
+    MPSolver solver("PS", MPSolver::GLOP_LINEAR_PROGRAMMING);
+    BuildPS_MIP(solver, jobs, l, bound, span, idx);
+    std::string model;
+    const bool mps = file.size() >= 4 && file.compare(file.size() - 4, 4, ".mps") == 0;
+    if(!(mps ? solver.ExportModelAsMpsFormat(false, false, &model) : solver.ExportModelAsLpFormat(false, &model)))
+        return false;
+    std::ofstream out(file);
+    if(!mps) out << "\\ The GCD of durations of all operations is " << idx.dGCD << "\n"
+                 << "\\ V = " << idx.V << "\n";
+    out << model;
+    return true;
+}
+} // namespace operations_research
@@ -11,6 +11,45 @@ void OpTopoSort(Job &job, uint16_t &o) {
     job.opTopo.push_back(o);
 }
 
+OpIndex IndexOperations(std::vector<Job> &jobs) {
+    OpIndex idx;
+    idx.dGCD = jobs[0].ops[0].duration;
+    for (uint16_t i = 0; i < jobs.size(); i++)
+        for (uint16_t j = 0; j < jobs[i].ops.size(); j++) {
+            idx.dGCD = std::__gcd(idx.dGCD, jobs[i].ops[j].duration);
+            jobs[i].ops[j].ij = idx.ops.size();
+            idx.ops.push_back(&jobs[i].ops[j]);
+        }
+    const size_t N = idx.ops.size();
+    idx.job.resize(N);
+    idx.local.resize(N);
+    idx.reach.resize(N);
+    idx.head.assign(N, 0);
+    idx.tail.assign(N, 0);
+    for (uint16_t i = 0; i < jobs.size(); i++) {
+        const size_t words = (jobs[i].ops.size() + 63) / 64;
+        for (auto &o : jobs[i].opTopo) {
+            const uint16_t ij = jobs[i].ops[o].ij;
+            idx.V += jobs[i].ops[o].duration / idx.dGCD;
+            idx.job[ij] = i;
+            idx.local[ij] = o;
+            idx.reach[ij].assign(words, 0);
+            for (auto &d : jobs[i].ops[o].deps) {
+                const uint16_t dj = jobs[i].ops[d].ij;
+                for (size_t k = 0; k < words; k++) idx.reach[ij][k] |= idx.reach[dj][k];
+                idx.reach[ij][d / 64] |= 1ULL << (d % 64);
+                idx.head[ij] = std::max<int64_t>(idx.head[ij], idx.head[dj] + idx.ops[dj]->duration / idx.dGCD);
+            }
+        }
+        for (auto o = jobs[i].opTopo.rbegin(); o != jobs[i].opTopo.rend(); ++o)
+            for (auto &d : jobs[i].ops[*o].deps) {
+                const uint16_t ij = jobs[i].ops[*o].ij, dj = jobs[i].ops[d].ij;
+                idx.tail[dj] = std::max<int64_t>(idx.tail[dj], idx.tail[ij] + idx.ops[ij]->duration / idx.dGCD);
+            }
+    }
+    return idx;
+}
+
 std::pair<uint16_t, std::vector<Job>> ReadJobs(const std::string &file) {
     uint16_t l{}; // Number of available slices
     uint16_t n{}; // Number of jobs
@@ -83,6 +122,64 @@ void WriteSchedule(
     }
 }
 
+// Merge every chain whose inner links are the only successor of one operation
+// and the only dependency of the next, needing the same number of slices.
+// A composite operation runs its chain back to back on the same slices.
+std::vector<Job> ContractChains(const std::vector<Job> &jobs, ChainMap &chains) {
+    std::vector<Job> contracted(jobs.size());
+    chains.assign(jobs.size(), {});
+    for (size_t j = 0; j < jobs.size(); j++) {
+        const Job &job = jobs[j];
+        const size_t m = job.ops.size();
+        std::vector<uint16_t> succ_count(m, 0), next(m, UINT16_MAX), composite(m);
+        std::vector<bool> linked(m, false);  // Merged with its dependency
+        for (auto &op : job.ops) for (auto &d : op.deps) succ_count[d]++;
+        for (uint16_t o = 0; o < m; o++) {
+            const Operation &op = job.ops[o];
+            if (op.deps.size() == 1 && succ_count[op.deps[0]] == 1 && job.ops[op.deps[0]].slices == op.slices) {
+                next[op.deps[0]] = o;
+                linked[o] = true;
+            }
+        }
+        Job &cj = contracted[j];
+        cj.weight = job.weight;
+        cj.duration = job.duration;
+        for (auto &o : job.opTopo) {
+            if (linked[o]) continue;
+            chains[j].emplace_back();
+            Operation cop;
+            cop.slices = job.ops[o].slices;
+            cop.deps = job.ops[o].deps;  // Remapped below
+            for (uint16_t k = o; k != UINT16_MAX; k = next[k]) {
+                chains[j].back().push_back(k);
+                composite[k] = cj.ops.size();
+                cop.duration += job.ops[k].duration;
+            }
+            cj.ops.push_back(cop);
+        }
+        for (auto &cop : cj.ops) for (auto &d : cop.deps) d = composite[d];
+        for (uint16_t o = 0; o < cj.ops.size(); o++) OpTopoSort(cj, o);
+        cj.ops[cj.opTopo.front()].front = true;
+        cj.ops[cj.opTopo.back()].back = true;
+    }
+    return contracted;
+}
+
+std::vector<Job> ExpandChains(const std::vector<Job> &jobs, const std::vector<Job> &contracted, const ChainMap &chains) {
+    if (chains.empty()) return contracted;
+    std::vector<Job> expanded(jobs);
+    for (size_t j = 0; j < jobs.size(); j++)
+        for (size_t c = 0; c < chains[j].size(); c++) {
+            uint32_t t = contracted[j].ops[c].start_time;
+            for (auto &o : chains[j][c]) {
+                expanded[j].ops[o].start_time = t;
+                expanded[j].ops[o].in_slice = contracted[j].ops[c].in_slice;
+                t += jobs[j].ops[o].duration;
+            }
+        }
+    return expanded;
+}
+
 long double CalculateScore(std::vector<Job> &jobs) {
     long double makespan = 0, weighted_flow = 0;
     for (size_t j = 0; j < jobs.size(); j++) {
@@ -97,50 +194,226 @@ long double CalculateScore(std::vector<Job> &jobs) {
     return weighted_flow + makespan;
 }
 
-uint32_t TraditionalScheduling(std::vector<Job> &jobs, const uint16_t &l) {
-    std::vector<uint16_t> j_order(jobs.size());
+// Same schedule as ListScheduling. The slices stay sorted by the time they
+// become free, packed as end << 8 | slice, so the chosen ones are a range
+// found by counting and moved back into order by a rotate instead of a sort.
+// The entries l..L-1 never become free.
+template <uint16_t L>
+uint32_t ListSchedulingKernel(std::vector<Job> &jobs, const uint16_t &l, const std::vector<std::pair<uint16_t, uint16_t>> &seq) {
+    std::array<uint64_t, L> slice;
+    slice.fill(std::numeric_limits<uint64_t>::max());
+    for (uint16_t q = 0; q < l; q++) slice[q] = q;
+    for (auto &[j, o] : seq) {
+        Operation &op = jobs[j].ops[o];
+        const uint32_t j_end = slice[op.slices-1] >> 8;
+        uint32_t j_start{j_end};
+        for (auto &d : op.deps) {
+            j_start = std::max<uint32_t>(j_start, jobs[j].ops[d].start_time + jobs[j].ops[d].duration);
+        }
+        op.start_time = j_start;
+        const uint64_t fin = op.start_time + op.duration;
+        uint16_t free = 0, before = 0;
+        for (uint16_t q = 0; q < L; q++) {
+            free += (slice[q] >> 8) <= j_start;
+            before += (slice[q] >> 8) < fin;
+        }
+        // The slices free the earliest, or if the dependencies finish later,
+        // the ones that became free the latest before j_start
+        const uint16_t first = j_start == j_end ? 0 : free - op.slices, last = first + op.slices;
+        op.in_slice.clear();
+        for (uint16_t s = first; s < last; s++) {
+            op.in_slice.push_back(slice[s] & 0xff);
+            slice[s] = fin << 8 | (slice[s] & 0xff);
+        }
+        std::rotate(slice.begin() + first, slice.begin() + last, slice.begin() + std::max(before, last));
+    }
+    return slice[l-1] >> 8;
+}
+
+template uint32_t ListSchedulingKernel<8>(std::vector<Job>&, const uint16_t &, const std::vector<std::pair<uint16_t, uint16_t>>&);
+template uint32_t ListSchedulingKernel<16>(std::vector<Job>&, const uint16_t &, const std::vector<std::pair<uint16_t, uint16_t>>&);
+template uint32_t ListSchedulingKernel<64>(std::vector<Job>&, const uint16_t &, const std::vector<std::pair<uint16_t, uint16_t>>&);
+template uint32_t ListSchedulingKernel<128>(std::vector<Job>&, const uint16_t &, const std::vector<std::pair<uint16_t, uint16_t>>&);
+
+uint32_t ListScheduling(std::vector<Job> &jobs, const uint16_t &l, const std::vector<std::pair<uint16_t, uint16_t>> &seq) {
+    if (l <= 8) return ListSchedulingKernel<8>(jobs, l, seq);
+    if (l <= 16) return ListSchedulingKernel<16>(jobs, l, seq);
+    if (l <= 64) return ListSchedulingKernel<64>(jobs, l, seq);
+    if (l <= 128) return ListSchedulingKernel<128>(jobs, l, seq);
     std::vector<uint32_t> slice_end(l, 0);
     std::vector<uint8_t> slice_order(l);
+    for (uint8_t q = 0; q < l; q++) slice_order[q] = q;
+    // Schedule each operation in the given (dependency-respecting) order
+    for (auto &[j, o] : seq) {
+        Operation &op = jobs[j].ops[o];
+        uint32_t j_end;
+        std::sort(slice_order.begin(), slice_order.end(), [&](const uint8_t &a, const uint8_t &b) {
+            return slice_end[a] < slice_end[b];
+        });
+        j_end = slice_end[slice_order[op.slices-1]];
+        uint32_t j_start{j_end};
+        for (auto &d : op.deps) {
+            j_start = std::max<uint32_t>(j_start, jobs[j].ops[d].start_time + jobs[j].ops[d].duration);
+        }
+        op.start_time = j_start;
+        op.in_slice.clear();
+        // std::cerr << o << " " << op.start_time << " " << j_start << " " << j_end << " " << op.slices << "\n";
+        if (j_start == j_end)
+            for (uint8_t s = 0; s < op.slices; s++) {
+                op.in_slice.push_back(slice_order[s]);
+                slice_end[slice_order[s]] = op.start_time + op.duration;
+            }
+        else {
+            uint8_t q{(uint8_t)(op.slices-1)};
+            while (q < l && slice_end[slice_order[q]] <= j_start) ++q;
+            for (uint8_t s = q-op.slices; s < q; s++) {
+                op.in_slice.push_back(slice_order[s]);
+                slice_end[slice_order[s]] = op.start_time + op.duration;
+            }
+        }
+    }
+    return *std::max_element(slice_end.begin(), slice_end.end());
+}
+
+uint32_t TraditionalScheduling(std::vector<Job> &jobs, const uint16_t &l) {
+    std::vector<uint16_t> j_order(jobs.size());
+    std::vector<std::pair<uint16_t, uint16_t>> seq;
     // Sort the jobs by weight in descending order
     for (uint8_t i = 0; i < jobs.size(); i++) j_order[i] = i;
     std::sort(j_order.begin(), j_order.end(), [&](const uint16_t &a, const uint16_t &b) {
         if (l == 1) return jobs[a].weight * jobs[b].duration > jobs[b].weight * jobs[a].duration;
         return jobs[a].weight > jobs[b].weight;
     });
-    for (uint8_t q = 0; q < l; q++) slice_order[q] = q;
-    for (auto &j : j_order) {
-        // Schedule each operation in the job
-        for (auto &o : jobs[j].opTopo) {
-            uint32_t j_end;
-            std::sort(slice_order.begin(), slice_order.end(), [&](const uint8_t &a, const uint8_t &b) {
-                return slice_end[a] < slice_end[b];
-            });
-            j_end = slice_end[slice_order[jobs[j].ops[o].slices-1]];
-            uint32_t j_start{j_end};
-            assert(!jobs[j].ops[o].done);
-            for (auto &d : jobs[j].ops[o].deps) {
-                j_start = std::max<uint32_t>(j_start, jobs[j].ops[d].start_time + jobs[j].ops[d].duration);
-            }
-            jobs[j].ops[o].start_time = j_start;
-            // std::cerr << o << " " << jobs[j].ops[o].start_time << " " << j_start << " " << j_end << " " << jobs[j].ops[o].slices << "\n";
-            if (j_start == j_end)
-                for (uint8_t s = 0; s < jobs[j].ops[o].slices; s++) {
-                    jobs[j].ops[o].in_slice.push_back(slice_order[s]);
-                    slice_end[slice_order[s]] = jobs[j].ops[o].start_time + jobs[j].ops[o].duration;
-                }
-            else {
-                uint8_t q{(uint8_t)(jobs[j].ops[o].slices-1)};
-                while (q < l && slice_end[slice_order[q]] <= j_start) ++q;
-                for (uint8_t s = q-jobs[j].ops[o].slices; s < q; s++) {
-                    jobs[j].ops[o].in_slice.push_back(slice_order[s]);
-                    slice_end[slice_order[s]] = jobs[j].ops[o].start_time + jobs[j].ops[o].duration;
+    for (auto &j : j_order)
+        for (auto &o : jobs[j].opTopo) seq.emplace_back(j, o);
+    return ListScheduling(jobs, l, seq);
+}
+
+// Compact a valid schedule towards an active one, never worsening its score.
+// Operations are visited in start time order. The first pass keeps their
+// slices and starts each one after its dependencies and the previous
+// operation on those slices. The next passes move each one into the earliest
+// gap of any slices, tracked per slice as start -> end, and are kept only if
+// they lower the score.
+long double LeftShift(std::vector<Job> &jobs, const uint16_t &l) {
+    std::vector<std::pair<uint16_t, uint16_t>> order;
+    auto sort_by_start = [&]() {
+        order.clear();
+        for (uint16_t j = 0; j < jobs.size(); j++)
+            for (uint16_t o = 0; o < jobs[j].ops.size(); o++) order.emplace_back(j, o);
+        std::stable_sort(order.begin(), order.end(), [&](const auto &a, const auto &b) {
+            return jobs[a.first].ops[a.second].start_time < jobs[b.first].ops[b.second].start_time;
+        });
+    };
+    auto ready = [](const Job &job, const Operation &op) {
+        uint32_t t = 0;
+        for (auto &d : op.deps) t = std::max<uint32_t>(t, job.ops[d].start_time + job.ops[d].duration);
+        return t;
+    };
+
+    std::vector<uint32_t> last(l, 0);
+    sort_by_start();
+    for (auto &[j, o] : order) {
+        Operation &op = jobs[j].ops[o];
+        uint32_t t = ready(jobs[j], op);
+        for (auto &q : op.in_slice) t = std::max(t, last[q]);
+        op.start_time = t;
+        for (auto &q : op.in_slice) last[q] = t + op.duration;
+    }
+    long double score = CalculateScore(jobs);
+
+    for (int pass = 0; pass < 8; pass++) {
+        std::vector<Job> shifted(jobs);
+        std::vector<std::map<uint32_t, uint32_t>> busy(l);
+        std::set<uint32_t> ends;
+        std::vector<std::pair<uint32_t, uint8_t>> free_slices;
+        sort_by_start();
+        for (auto &[j, o] : order) {
+            Operation &op = shifted[j].ops[o];
+            uint32_t t = ready(shifted[j], op);
+            for (;;) {
+                const uint32_t e = t + op.duration;
+                free_slices.clear();
+                for (uint8_t q = 0; q < l; q++) {
+                    auto it = busy[q].upper_bound(t);
+                    if (it != busy[q].end() && it->first < e) continue;
+                    uint32_t prev_end = 0;
+                    if (it != busy[q].begin() && (prev_end = std::prev(it)->second) > t) continue;
+                    free_slices.emplace_back(prev_end, q);
                 }
+                if (free_slices.size() >= op.slices) break;
+                t = *ends.upper_bound(t);
+            }
+            // Best fit: the slices that became free the latest
+            std::sort(free_slices.begin(), free_slices.end(), [](const auto &a, const auto &b) {
+                return a.first > b.first || (a.first == b.first && a.second < b.second);
+            });
+            op.start_time = t;
+            op.in_slice.clear();
+            for (uint8_t s = 0; s < op.slices; s++) {
+                op.in_slice.push_back(free_slices[s].second);
+                busy[free_slices[s].second][t] = t + op.duration;
             }
-            jobs[j].ops[o].done = true;
+            ends.insert(t + op.duration);
         }
-        // std::cerr << "\n";
+        const long double shifted_score = CalculateScore(shifted);
+        if (!(shifted_score < score)) break;
+        jobs.swap(shifted);
+        score = shifted_score;
     }
-    return *std::max_element(slice_end.begin(), slice_end.end());
+    return score;
+}
+
+InstanceFeatures Features(const std::vector<Job> &jobs, const uint16_t &l) {
+    InstanceFeatures f;
+    double deps = 0, wmin = std::numeric_limits<double>::infinity(), wmax = 0, wsum = 0;
+    f.l = l;
+    f.n = jobs.size();
+    for (auto &job : jobs) {
+        f.ops += job.ops.size();
+        for (auto &op : job.ops) deps += op.deps.size();
+        wmin = std::min(wmin, job.weight);
+        wmax = std::max(wmax, job.weight);
+        wsum += job.weight;
+    }
+    f.dep_density = deps / f.ops;
+    // Range over mean rather than max / min, which zero weights turn into inf or NaN
+    f.weight_spread = wsum > 0 ? std::log1p((wmax - wmin) * f.n / wsum) : 0;
+    return f;
+}
+
+// One line per tuned instance: features, then the configuration
+void WriteCPConfig(std::ostream &out, const InstanceFeatures &f, const CPConfig &c) {
+    out << f.l << " " << f.n << " " << f.ops << " " << f.dep_density << " " << f.weight_spread << " "
+        << c.group_size << " " << c.order << " " << c.workers << " " << c.search_branching << " "
+        << c.linearization_level << "\n";
+}
+
+// The configuration of the nearest tuned instance (1-nearest-neighbour), on log-scaled sizes
+CPConfig LoadCPConfig(const std::string &file, const InstanceFeatures &f) {
+    std::ifstream in(file);
+    std::string line;
+    CPConfig best;
+    double best_dist = std::numeric_limits<double>::infinity();
+    auto dist = [](const InstanceFeatures &a, const InstanceFeatures &b) {
+        auto sq = [](const double &x) { return x * x; };
+        return sq(std::log(a.l / b.l)) + sq(std::log(a.n / b.n)) + sq(std::log(a.ops / b.ops))
+             + sq(a.dep_density - b.dep_density) + sq(a.weight_spread - b.weight_spread);
+    };
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::stringstream ss(line);
+        InstanceFeatures g;
+        CPConfig c;
+        if (!(ss >> g.l >> g.n >> g.ops >> g.dep_density >> g.weight_spread >> c.group_size >> c.order
+                 >> c.workers >> c.search_branching >> c.linearization_level)) continue;
+        const double d = dist(f, g);
+        if (d < best_dist) {
+            best_dist = d;
+            best = c;
+        }
+    }
+    return best;
 }
 
 // There is a time limit of 12 hours for the public tests combined
@@ -1,4 +1,5 @@
 #include <algorithm>   // for max, copy, fill_n
+#include <array>       // for array
 #include <cassert>     // for assert
 #include <cfenv>       // for feenableexcept
 #include <cmath>       // for isfinite
@@ -9,8 +10,10 @@
 #include <iomanip>     // for operator<<, setprecision
 #include <iostream>    // for operator<<, ifstream, basic_istream::operat...
 #include <limits>      // for numeric_limits
+#include <map>         // for map
 #include <memory>      // for allocator, allocator_traits<>::value_type
 #include <regex>       // for regex_match, match_results<>::_Base_type
+#include <set>         // for set
 #include <sstream>     // for stringstream
 #include <string>      // for string, basic_string, operator+, char_traits
 #include <tuple>       // for tuple
@@ -35,16 +38,84 @@ struct Job {
     std::vector<uint16_t> opTopo;
 };
 
+// All the operations in one array (Operation::ij is the position), with the
+// transitive closure of every job DAG and the head/tail of each operation in
+// units of dGCD. A feasible operation runs within [head, horizon - tail].
+struct OpIndex {
+    std::vector<Operation*> ops;
+    std::vector<uint16_t> job, local;
+    std::vector<std::vector<uint64_t>> reach;  // Operations of the same job that must finish first
+    std::vector<int64_t> head, tail;
+    uint32_t dGCD{}, V{};  // V: sum of the durations
+    bool Precedes(const int &a, const int &b) const {
+        return job[a] == job[b] && (reach[b][local[a] / 64] >> (local[a] % 64) & 1);
+    }
+    bool Apart(const int &a, const int &b, const int64_t &horizon) const {
+        return horizon - tail[a] <= head[b] || horizon - tail[b] <= head[a];
+    }
+};
+
+// Parameters of RunPS_CP, picked per instance from the autotuner output
+struct CPConfig {
+    uint16_t group_size{0};       // 0: 12 if l >= 9, 20 if l >= 6, otherwise all the jobs
+    std::string order{"weight"};  // Job order of the groups: weight, ratio or duration
+    uint16_t workers{32};
+    int search_branching{-1};     // SatParameters::SearchBranching, -1: CP-SAT default
+    int linearization_level{-1};
+    double max_time{0};           // Seconds for all the groups, 0: timeLimit(); set by the autotuner only
+};
+
+struct InstanceFeatures {
+    double l{}, n{}, ops{}, dep_density{}, weight_spread{};
+};
+
 void OpTopoSort(Job&, uint16_t&);
 
+OpIndex IndexOperations(std::vector<Job>&);
+
 std::pair<uint16_t, std::vector<Job>> ReadJobs(const std::string&);
 
 void WriteSchedule(const std::string &, const std::vector<Job> &);
 
+// [job][composite operation] -> the original operations in chain order
+using ChainMap = std::vector<std::vector<std::vector<uint16_t>>>;
+
+std::vector<Job> ContractChains(const std::vector<Job>&, ChainMap&);
+
+std::vector<Job> ExpandChains(const std::vector<Job>&, const std::vector<Job>&, const ChainMap&);
+
 long double CalculateScore(std::vector<Job>&);
 
+uint32_t ListScheduling(std::vector<Job>&, const uint16_t &, const std::vector<std::pair<uint16_t, uint16_t>>&);
+
+// ListScheduling for l <= L with the slice state on the stack, instantiated for L = 8, 16, 64 and 128
+template <uint16_t L>
+uint32_t ListSchedulingKernel(std::vector<Job>&, const uint16_t &, const std::vector<std::pair<uint16_t, uint16_t>>&);
+
 uint32_t TraditionalScheduling(std::vector<Job>&, const uint16_t &);
 
+// Biased random-key GA, islands evolved on a thread pool
+struct GAParams {
+    uint64_t seed{1};
+    uint16_t threads{0};     // 0: std::thread::hardware_concurrency()
+    uint16_t islands{0};     // 0: one island per thread
+    uint16_t population{64};
+    uint16_t generations{200};
+    uint16_t migration{20};  // Generations between migrations
+    uint16_t migrants{2};
+    double elite{0.2}, mutant{0.15}, rho{0.7};
+};
+
+long double RunPS_GA(std::vector<Job>&, const uint16_t &, const GAParams &);
+
+long double LeftShift(std::vector<Job>&, const uint16_t &);
+
+InstanceFeatures Features(const std::vector<Job>&, const uint16_t &);
+
+void WriteCPConfig(std::ostream&, const InstanceFeatures&, const CPConfig&);
+
+CPConfig LoadCPConfig(const std::string&, const InstanceFeatures&);
+
 int timeLimit(const uint32_t&, const uint32_t, bool);
 
 #endif